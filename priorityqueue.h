@@ -1,10 +1,13 @@
-/* This file contains the implementation of a priority queue class template. The priority queue is implemented using a custom binary search tree (BST). Each node in the BST contains a priority value and a corresponding value. The priority queue supports insertion, removal, and retrieval of elements based on their priority. Duplicate priorities are also supported, and the priority queue maintains the order of elements with the same priority using a linked list. The class provides various member functions such as enqueue, dequeue, clear, begin, next, size, toString, and peek. The priority queue is implemented as a template, allowing it to store elements of any type. This file also includes necessary header files, such as iostream, sstream, and set, and provides a default constructor, destructor, and assignment operator for the priority queue class. The code is a part of the CS 251 Spring 2023 course at the University of Illinois Chicago. */
+/* This file contains the implementation of a priority queue class template. The priority queue is implemented using a custom binary search tree (BST). Each node in the BST contains a priority value and a corresponding value. The priority queue supports insertion, removal, and retrieval of elements based on their priority. Duplicate priorities are also supported, and the priority queue maintains the order of elements with the same priority using a linked list. The class provides various member functions such as enqueue, dequeue, clear, begin, next, size, toString, and peek. The priority queue is implemented as a template, allowing it to store elements of any type. This file also includes necessary header files, such as iostream, sstream, and set, and provides a default constructor, destructor, and assignment operator for the priority queue class. Priorities that land close to the current front of the queue are first parked in a hierarchical timing wheel, which gives O(1) enqueue and cancel, and are cascaded into the BST only once they become the next items to leave. The code is a part of the CS 251 Spring 2023 course at the University of Illinois Chicago. */
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <set>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -15,16 +18,62 @@ private:
         int priority;  // used to build BST
         T value;  // stored data for the p-queue
         bool dup;  // marked true when there are duplicate priorities
+        int ticket;  // pool entry of this element (see cancel)
         NODE* parent;  // links back to parent
         NODE* link;  // links to linked list of NODES with duplicate priorities
         NODE* left;  // links to left child
         NODE* right;  // links to right child
     };
     NODE* root;  // pointer to root node of the BST
-    int size;  // # of elements in the pqueue
-    NODE* curr;  // pointer to next item in pqueue (see begin and next)
-    
+    int size;  // # of elements in the BST
+    NODE* curr;  // pointer to next BST item in pqueue (see begin and next)
+    vector<int> currWheel;  // wheel entries in order, snapshot taken by begin
+    int currWheelPos;  // next item in currWheel
+
+    // Timing wheel in front of the BST.  Level k has WHEEL_SLOTS slots that
+    // each span 2^(WHEEL_BITS*k) priorities.  Levels below the top are
+    // aligned to the block of "base"; the top level wraps around, so it
+    // reaches up to WHEEL_SLOTS - 1 top-level slots past the block of base.
+    // Anything below base or further out goes to the BST.  Base only moves
+    // forward while the wheel holds elements, so entries only move down.
+    static const int WHEEL_BITS = 6;
+    static const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+    static const int WHEEL_LEVELS = 4;
+
+    // WHEELNODE::level values for elements that are not in a wheel slot
+    static const int ENTRY_TREE = -1;
+    static const int ENTRY_FREE = -2;
+
+    // Every queued element owns one entry, wherever it is stored.
+    struct WHEELNODE {
+        int priority;
+        T value;  // held only while the entry is in the wheel, T() otherwise
+        unsigned int gen;  // bumped when the entry is freed so stale tickets miss
+        int level;  // wheel level holding the entry, ENTRY_TREE or ENTRY_FREE
+        int slot;  // slot within that level
+        int prev;  // previous entry in the slot, -1 at the head
+        int next;  // next entry in the slot (or free list), -1 at the tail
+        NODE* node;  // BST node holding the element when level is ENTRY_TREE
+    };
+    vector<WHEELNODE> pool;  // entries, addressed by index
+    int freeHead;  // first free entry in pool, -1 if none
+    int heads[WHEEL_LEVELS][WHEEL_SLOTS];  // first entry of each slot
+    int tails[WHEEL_LEVELS][WHEEL_SLOTS];  // last entry of each slot
+    int wheelSize;  // # of elements in the wheel
+    int base;  // lowest priority the wheel may hold
+
 public:
+    //
+    // TICKET
+    //
+    // Returned by enqueue and passed to cancel.  A ticket stays valid until
+    // its element leaves the queue, whether it is in the wheel or the BST.
+    //
+    struct TICKET {
+        int index;
+        unsigned int gen;
+    };
+
     //
     // default constructor:
     //
@@ -35,59 +84,91 @@ public:
         root = nullptr;
         size = 0;
         curr = nullptr;
+        currWheelPos = 0;
+        freeHead = -1;
+        wheelSize = 0;
+        base = 0;
+        for (int k = 0; k < WHEEL_LEVELS; k++) {
+            for (int j = 0; j < WHEEL_SLOTS; j++) {
+                heads[k][j] = -1;
+                tails[k][j] = -1;
+            }
+        }
     }
-    
+
+    //
+    // copy constructor:
+    //
+    // Creates a copy of the "other" priority queue.
+    // O(n), where n is total number of elements in the priority queue
+    //
+    priorityqueue(const priorityqueue& other) : priorityqueue() {
+        *this = other;
+    }
+
     //
     // operator=
     //
-    // Clears "this" tree and then makes a copy of the "other" tree.
+    // Clears "this" queue and then makes a copy of the "other" queue, wheel
+    // included.  Tickets are only meant for the queue that issued them;
+    // ones this queue issued before the assignment stay stale.
     // Sets all member variables appropriately.
-    // O(n), where n is total number of nodes in custom BST
+    // O(n), where n is total number of elements in the priority queue
     //
     priorityqueue& operator=(const priorityqueue& other) {
         if (this != &other) {
             // Clear the current tree
             clear();
 
+            // Copy the wheel entries.  Entries this queue already had keep
+            // their own gen, so tickets it issued before stay stale.
+            int oldSize = (int)pool.size();
+            if ((int)other.pool.size() > oldSize) {
+                pool.resize(other.pool.size());
+            }
+            for (int i = 0; i < (int)other.pool.size(); i++) {
+                unsigned int gen = (i < oldSize ? pool[i].gen : other.pool[i].gen);
+                pool[i] = other.pool[i];
+                pool[i].gen = gen;
+            }
+            freeHead = other.freeHead;
+            for (int i = (int)other.pool.size(); i < oldSize; i++) {
+                pool[i].next = freeHead;
+                freeHead = i;
+            }
+            for (int k = 0; k < WHEEL_LEVELS; k++) {
+                for (int j = 0; j < WHEEL_SLOTS; j++) {
+                    heads[k][j] = other.heads[k][j];
+                    tails[k][j] = other.tails[k][j];
+                }
+            }
+            wheelSize = other.wheelSize;
+            base = other.base;
+
             // Copy the other tree
             copyTree(other.root);
 
-            // Copy the size and curr pointers
+            // Copy the size and traversal state
             size = other.size;
+            curr = nullptr;
             if (other.curr != nullptr) {
+                NODE* otherNode = other.findNode(other.root, other.curr->priority);
                 curr = findNode(root, other.curr->priority);
-            } else {
-                curr = nullptr;
+                while (otherNode != other.curr) {
+                    otherNode = otherNode->link;
+                    curr = curr->link;
+                }
             }
+            currWheel = other.currWheel;
+            currWheelPos = other.currWheelPos;
         }
         return *this;
     }
 
-    // Helper function to copy a tree from another tree
-    void copyTree(NODE* otherNode) {
-        if (otherNode != nullptr) {
-            // Enqueue the node in the current tree
-            enqueue(otherNode->value, otherNode->priority);
-
-            // If the node has duplicates, enqueue them as well
-            if (otherNode->dup) {
-                NODE* otherLink = otherNode->link;
-                while (otherLink != nullptr) {
-                    enqueue(otherLink->value, otherLink->priority);
-                    otherLink = otherLink->link;
-                }
-            }
-
-            // Recursively copy the left and right subtrees
-            copyTree(otherNode->left);
-            copyTree(otherNode->right);
-        }
-    }
-    
     // This function takes a pointer to a node in the tree and a priority value to search for.
     // If the node is null or the priority of the node matches the search priority, the node is returned.
     // Otherwise, the function recursively searches either the left or right subtree depending on the priority value.
-    NODE* findNode(NODE* node, int priority) {
+    NODE* findNode(NODE* node, int priority) const {
         if (node == nullptr || node->priority == priority) {
             return node;
         } else if (priority < node->priority) {
@@ -96,213 +177,166 @@ public:
             return findNode(node->right, priority);
         }
     }
-    
-    
-    
+
+    //
+    // findNode:
+    //
+    // Returns the first node with the priority, or nullptr if none is queued.
+    // Elements with that priority that are still in the wheel are moved into
+    // the BST first; their tickets stay valid.
+    // O(logn + m + s), where n is number of unique nodes in tree, m is number
+    // of duplicate priorities and s is number of elements in the wheel slot
+    //
+    NODE* findNode(int priority) {
+        int level = wheelLevel(priority);
+        if (wheelSize > 0 && level >= 0) {
+            int slot = (wheelKey(priority) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+            int index = heads[level][slot];
+            while (index != -1) {
+                int nextIndex = pool[index].next;
+                if (pool[index].priority == priority) {
+                    unlinkEntry(index);
+                    wheelSize--;
+                    insertNode(move(pool[index].value), priority, index);
+                }
+                index = nextIndex;
+            }
+        }
+        return findNode(root, priority);
+    }
+
+
+
     //
     // clear:
     //
     // Frees the memory associated with the priority queue but is public.
-    // O(n), where n is total number of nodes in custom BST
+    // O(n), where n is total number of elements in the priority queue
     //
     void clear() {
         clearHelper(root);
 
+        // Release every wheel entry; bumping gen invalidates old tickets
+        for (int k = 0; k < WHEEL_LEVELS; k++) {
+            for (int j = 0; j < WHEEL_SLOTS; j++) {
+                int index = heads[k][j];
+                while (index != -1) {
+                    int nextIndex = pool[index].next;
+                    freeEntry(index);
+                    index = nextIndex;
+                }
+                heads[k][j] = -1;
+                tails[k][j] = -1;
+            }
+        }
+
         // Reset member variables
         root = nullptr;
         size = 0;
         curr = nullptr;
+        currWheel.clear();
+        currWheelPos = 0;
+        wheelSize = 0;
+        base = 0;
     }
 
-    void clearHelper(NODE* node) {
-        if (node != nullptr) {
-            // Recursively clear the left and right subtrees
-            clearHelper(node->left);
-            clearHelper(node->right);
-
-            // Delete the current node and any linked list nodes
-            if (node->link != nullptr) {
-                NODE* linkNode = node->link;
-                while (linkNode != nullptr) {
-                    NODE* nextNode = linkNode->link;
-                    delete linkNode;
-                    linkNode = nextNode;
-                }
-            }
-            delete node;
-        }
-    }
-    
     //
     // destructor:
     //
     // Frees the memory associated with the priority queue.
-    // O(n), where n is total number of nodes in custom BST
+    // O(n), where n is total number of elements in the priority queue
     //
     ~priorityqueue() {
         clear();
     }
-    
+
     //
     // enqueue:
     //
-    // Inserts the value into the custom BST in the correct location based on
-    // priority.
-    // O(logn + m), where n is number of unique nodes in tree and m is number
-    // of duplicate priorities
-    //
-    void enqueue(T value, int priority) {
-        // Create a new node with the given value and priority
-        NODE* newNode = new NODE;
-        newNode->priority = priority;
-        newNode->value = value;
-        newNode->dup = false;
-        newNode->parent = nullptr;
-        newNode->link = nullptr;
-        newNode->left = nullptr;
-        newNode->right = nullptr;
-
-        // If the tree is empty, set newNode as root
-        if (root == nullptr) {
-            root = newNode;
-            size++;
-            return;
+    // Inserts the value into the priority queue and returns a ticket that
+    // can be passed to cancel.  The wheel's base only moves forward while it
+    // holds elements; an empty wheel is anchored at the new priority.
+    // Priorities below base, or more than WHEEL_SLOTS - 1 top-level slots
+    // (about 2^24) past it, go to the custom BST.
+    // O(1) for wheel priorities, otherwise O(logn + m), where n is number of
+    // unique nodes in tree and m is number of duplicate priorities
+    //
+    TICKET enqueue(T value, int priority) {
+        int index = freeHead;
+        if (index != -1) {
+            freeHead = pool[index].next;
+        } else {
+            index = (int)pool.size();
+            pool.push_back(WHEELNODE());
+            pool[index].gen = 0;
         }
+        pool[index].priority = priority;
+        pool[index].value = move(value);
 
-        NODE* currNode = root;
-        NODE* prevNode = nullptr;
-
-        // Traverse the tree to find the correct location for newNode
-        while (currNode != nullptr) {
-            if (priority == currNode->priority) {
-                // If the priority already exists in the tree, add newNode to its linked list
-                newNode->dup = true;
-                while (currNode->link != nullptr) {
-                    currNode = currNode->link;
-                }
-                currNode->link = newNode;
-
-                size++;
-                return;
-            }
-            prevNode = currNode;
-            if (priority < currNode->priority) {
-                currNode = currNode->left;
-            } else {
-                currNode = currNode->right;
-            }
+        // An empty wheel can be re-anchored for free
+        if (wheelSize == 0) {
+            base = priority;
         }
+        placeEntry(index);
+        return TICKET{index, pool[index].gen};
+    }
 
-        // Attach newNode to the correct leaf node
-        newNode->parent = prevNode;
-        if (priority < prevNode->priority) {
-            prevNode->left = newNode;
+    //
+    // cancel:
+    //
+    // Removes the element behind the ticket and returns true.  Returns false
+    // only if the element is no longer in the queue (dequeued, cancelled or
+    // cleared).
+    // O(1) while the element is in the wheel, otherwise O(logn + m), where n
+    // is number of unique nodes in tree and m is number of duplicate
+    // priorities
+    //
+    bool cancel(TICKET ticket) {
+        if (ticket.index < 0 || ticket.index >= (int)pool.size()) {
+            return false;
+        }
+        WHEELNODE& entry = pool[ticket.index];
+        if (entry.gen != ticket.gen || entry.level == ENTRY_FREE) {
+            return false;
+        }
+        if (entry.level == ENTRY_TREE) {
+            removeNode(entry.node);
+            size--;
         } else {
-            prevNode->right = newNode;
+            unlinkEntry(ticket.index);
+            wheelSize--;
         }
-        size++;
+        freeEntry(ticket.index);
+        return true;
     }
 
-    
     //
     // dequeue:
     //
     // returns the value of the next element in the priority queue and removes
     // the element from the priority queue.
-    // O(logn + m), where n is number of unique nodes in tree and m is number
-    // of duplicate priorities
+    // O(logn + m) plus a scan of at most WHEEL_LEVELS * WHEEL_SLOTS wheel
+    // slots, where n is number of unique nodes in tree and m is number of
+    // duplicate priorities.  Cascades come on top of that but are amortized:
+    // each wheel element moves down at most WHEEL_LEVELS - 1 levels and into
+    // the BST once.
     //
     T dequeue() {
+        settle();
         if (root == nullptr) {
             throw logic_error("Cannot dequeue from an empty priority queue");
         }
 
-        // Traverse the tree to find the node with the highest priority
-        NODE* node = root;
-        while (node->left != nullptr) {
-            node = node->left;
-        }
-        if (node->link != nullptr) {
-            // If there are duplicates with the same priority, remove the first one
-            if (node == root) {
-                root = node->link;
-                T value = node->value;
-                delete node;
-                size--;
-                return value;
-            }
-            if (node->parent->left == node) {
-                node->parent->left = node->link;
-            } else {
-                node->parent->right = node->link;
-            }
-            node->link->parent = node->parent;
-            T value = node->value;
-            delete node;
-            size--;
-            return value;
-        } else {
-            // If there are no duplicates, remove the node
-            T value = node->value;
-            removeNode(node);
-            size--;
-            return value;
-        }
+        // The leftmost node has the highest priority; if it has duplicates,
+        // removeNode lets the next one take its place
+        NODE* node = leftmostNode(root);
+        T value = move(node->value);
+        freeEntry(node->ticket);
+        removeNode(node);
+        size--;
+        return value;
     }
 
-    void removeNode(NODE* node) {
-        if (node == root) {
-            if (node->right != nullptr) {
-                root = node->right;
-                return;
-            } else {
-                return;
-            }
-        }
-        if (node->left == nullptr && node->right == nullptr) {
-            // If the node has no children, just remove it
-            if (node->parent == nullptr) {
-                // If the node is the root, set root to nullptr
-                root = nullptr;
-            } else {
-                // Otherwise, remove the link to this node from its parent
-                if (node->parent->left == node) {
-                    node->parent->left = nullptr;
-                } else {
-                    node->parent->right = nullptr;
-                }
-            }
-            delete node;
-        } else if (node->left == nullptr || node->right == nullptr) {
-            // If the node has only one child, replace it with that child
-            NODE* childNode = (node->left == nullptr ? node->right : node->left);
-            childNode->parent = node->parent;
-            if (node->parent == nullptr) {
-                // If the node is the root, set root to the child
-                root = childNode;
-            } else {
-                // Otherwise, replace the link to this node with a link to its child
-                if (node->parent->left == node) {
-                    node->parent->left = childNode;
-                } else {
-                    node->parent->right = childNode;
-                }
-            }
-            delete node;
-        } else {
-            // If the node has two children, replace it with the successor
-            NODE* successorNode = node->left;
-            while (successorNode->right != nullptr) {
-                successorNode = successorNode->right;
-            }
-            node->priority = successorNode->priority;
-            node->value = successorNode->value;
-            removeNode(successorNode);
-        }
-    }
-    
-    
-    
     //
     // Size:
     //
@@ -310,39 +344,36 @@ public:
     // O(1)
     //
     int Size() {
-        return size;
+        return size + wheelSize;
     }
-    
-    
+
+
     //
     // begin
     //
     // Resets internal state for an inorder traversal.  After the
     // call to begin(), the internal state denotes the first inorder
     // node; this ensure that first call to next() function returns
-    // the first inorder node value.
+    // the first inorder node value.  The traversal covers the wheel without
+    // moving anything; call begin() again after the queue changes.
     //
-    // O(logn), where n is number of unique nodes in tree
+    // O(logn + w log w), where n is number of unique nodes in tree and w is
+    // number of elements in the wheel
     //
     // Example usage:
     //    pq.begin();
-    //    while (tree.next(value, priority)) {
+    //    while (pq.next(value, priority)) {
     //      cout << priority << " value: " << value << endl;
     //    }
-    //    cout << priority << " value: " << value << endl;
     void begin() {
-        if (root == nullptr) {
-            curr = nullptr;
-            return;
-        }
-        curr = root;
-        while (curr->left != nullptr) {
-            curr = curr->left;
-        }
+        curr = (root == nullptr ? nullptr : leftmostNode(root));
+        currWheel.clear();
+        wheelOrder(currWheel);
+        currWheelPos = 0;
     }
 
-    
-    
+
+
     //
     // next
     //
@@ -362,52 +393,11 @@ public:
     //    while (pq.next(value, priority)) {
     //      cout << priority << " value: " << value << endl;
     //    }
-    //    cout << priority << " value: " << value << endl;
     //
     bool next(T& value, int& priority) {
-            if (root == nullptr) {
-                return false;
-            }
-            if (curr == nullptr) {
-                // If curr is null, start from the root
-                curr = root;
-                while (curr->left != nullptr) {
-                    curr = curr->left;
-                }
-                value = curr->value;
-                priority = curr->priority;
-                return true;
-            }
-            NODE* nextNode = nullptr;
-            if (curr->right != nullptr) {
-                // If curr has a right subtree, go to the leftmost node in the right subtree
-                nextNode = curr->right;
-                while (nextNode->left != nullptr) {
-                    nextNode = nextNode->left;
-                }
-            } else {
-                // Otherwise, go up the tree until we find a node that is a left child
-                NODE* parentNode = curr->parent;
-                while (parentNode != nullptr && curr == parentNode->right) {
-                    curr = parentNode;
-                    parentNode = parentNode->parent;
-                }
-                nextNode = parentNode;
-            }
-            if (nextNode == nullptr) {
-                return false;
-            }
-            curr = nextNode;
-            value = curr->value;
-            priority = curr->priority;
-            return true;
-        }
-
-
-
+        return nextElement(curr, currWheel, currWheelPos, value, priority);
+    }
 
-    
-    
     //
     // toString:
     //
@@ -417,148 +407,485 @@ public:
     //  2 value: Sven
     //  3 value: Gwen"
     //
-    string toString() {
+    string toString() const {
         stringstream ss;
-        inorderPrint(root, ss);
-        return ss.str();
-    }
-    
-    void inorderPrint(NODE* node, stringstream& ss) {
-        if (node != nullptr) {
-            inorderPrint(node->left, ss);
-            ss << node->priority << " value: " << node->value << endl;
-            if (node->link != nullptr) {
-                NODE* curr = node->link;
-                while (curr != nullptr) {
-                    ss << node->priority << " value: " << curr->value << endl;
-                    curr = curr->link;
-                }
-            }
-            inorderPrint(node->right, ss);
+        NODE* node = (root == nullptr ? nullptr : leftmostNode(root));
+        vector<int> order;
+        wheelOrder(order);
+        int pos = 0;
+        T value;
+        int priority;
+        while (nextElement(node, order, pos, value, priority)) {
+            ss << priority << " value: " << value << endl;
         }
+        return ss.str();
     }
-    
-    
+
+
     //
     // peek:
     //
     // returns the value of the next element in the priority queue but does not
     // remove the item from the priority queue.
-    // O(logn + m), where n is number of unique nodes in tree and m is number
-    // of duplicate priorities
+    // Same bounds as dequeue.
     //
     T peek() {
+        settle();
         NODE* currNode = root;
         while (currNode->left != nullptr) {
             currNode = currNode->left;
         }
         return currNode->value;
     }
-    
+
     //
     // ==operator
     //
-    // Returns true if this priority queue as the priority queue passed in as
-    // other.  Otherwise returns false.
-    // O(n), where n is total number of nodes in custom BST
+    // Returns true if this priority queue holds the same elements, in the
+    // same order, as the priority queue passed in as other.  Otherwise
+    // returns false.  Neither queue is modified.
+    // O(n + w log w), where n is total number of elements in the priority
+    // queues and w is number of elements in their wheels
     //
     bool operator==(const priorityqueue<T>& other) const {
         // If the sizes of the two priority queues are different, they are not equal
-        if (size != other.size) {
+        if (size + wheelSize != other.size + other.wheelSize) {
             return false;
         }
 
-        // Create two pointers to traverse the two priority queues
-        NODE* thisPtr = root;
-        NODE* otherPtr = other.root;
-
-        // Traverse the two priority queues using in-order traversal until we have
-        // compared all the elements in both priority queues or we find a pair of
-        // elements that are not equal
-        while (thisPtr != nullptr && otherPtr != nullptr) {
-            // If the priorities of the two nodes are different, the priority queues
-            // are not equal
-            if (thisPtr->priority != otherPtr->priority) {
+        // Walk both priority queues in order and compare element by element
+        NODE* thisNode = (root == nullptr ? nullptr : leftmostNode(root));
+        NODE* otherNode = (other.root == nullptr ? nullptr : other.leftmostNode(other.root));
+        vector<int> thisOrder;
+        vector<int> otherOrder;
+        wheelOrder(thisOrder);
+        other.wheelOrder(otherOrder);
+        int thisPos = 0;
+        int otherPos = 0;
+        T thisValue;
+        T otherValue;
+        int thisPriority;
+        int otherPriority;
+        while (nextElement(thisNode, thisOrder, thisPos, thisValue, thisPriority)) {
+            other.nextElement(otherNode, otherOrder, otherPos, otherValue, otherPriority);
+            if (thisPriority != otherPriority || thisValue != otherValue) {
                 return false;
             }
+        }
+        return true;
+    }
 
-            // If the values of the two nodes are different, the priority queues are
-            // not equal
-            if (thisPtr->value != otherPtr->value) {
-                return false;
+    NODE* leftmostNode(NODE* node) const {
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+        return node;
+    }
+
+    //
+    // getRoot - Do not edit/change!
+    //
+    // Used for testing the BST.
+    // return the root node for testing.
+    //
+    void* getRoot() {
+        return root;
+    }
+
+private:
+    // Helper function to copy a tree from another tree
+    void copyTree(NODE* otherNode) {
+        if (otherNode != nullptr) {
+            // Insert the node in the current tree
+            insertNode(otherNode->value, otherNode->priority, otherNode->ticket);
+
+            // If the node has duplicates, insert them as well
+            NODE* otherLink = otherNode->link;
+            while (otherLink != nullptr) {
+                insertNode(otherLink->value, otherLink->priority, otherLink->ticket);
+                otherLink = otherLink->link;
             }
 
-            // If the current nodes have duplicates, compare the linked lists
-            if (thisPtr->link != nullptr && otherPtr->link != nullptr) {
-                NODE* thisLink = thisPtr->link;
-                NODE* otherLink = otherPtr->link;
-                while (thisLink != nullptr && otherLink != nullptr) {
-                    if (thisLink->priority != otherLink->priority) {
-                        return false;
-                    }
-                    if (thisLink->value != otherLink->value) {
-                        return false;
-                    }
-                    thisLink = thisLink->link;
-                    otherLink = otherLink->link;
-                }
-                if (thisLink != nullptr || otherLink != nullptr) {
-                    return false;
+            // Recursively copy the left and right subtrees
+            copyTree(otherNode->left);
+            copyTree(otherNode->right);
+        }
+    }
+
+    void clearHelper(NODE* node) {
+        if (node != nullptr) {
+            // Recursively clear the left and right subtrees
+            clearHelper(node->left);
+            clearHelper(node->right);
+
+            // Delete the current node and any linked list nodes
+            if (node->link != nullptr) {
+                NODE* linkNode = node->link;
+                while (linkNode != nullptr) {
+                    NODE* nextNode = linkNode->link;
+                    freeEntry(linkNode->ticket);
+                    delete linkNode;
+                    linkNode = nextNode;
                 }
-            } else if (thisPtr->dup != otherPtr->dup) {
-                // If one of the nodes has duplicates and the other does not, the
-                // priority queues are not equal
-                return false;
             }
+            freeEntry(node->ticket);
+            delete node;
+        }
+    }
 
-            // Move to the next node in the two priority queues using in-order
-            // traversal
-            if (thisPtr->right != nullptr && otherPtr->right != nullptr) {
-                // If both nodes have a right child, move to the leftmost node in
-                // the right subtree
-                thisPtr = leftmostNode(thisPtr->right);
-                otherPtr = leftmostNode(otherPtr->right);
-            } else if (thisPtr->right != nullptr || otherPtr->right != nullptr) {
-                // If one node has a right child and the other does not, the
-                // priority queues are not equal
-                return false;
-            } else {
-                // If neither node has a right child, move up the tree until we
-                // find a node that has not been visited yet
-                while (thisPtr->parent != nullptr && thisPtr == thisPtr->parent->right) {
-                    thisPtr = thisPtr->parent;
-                    otherPtr = otherPtr->parent;
+    //
+    // insertNode:
+    //
+    // Inserts the value into the custom BST in the correct location based on
+    // priority, and points the pool entry "ticket" at the new node.
+    // O(logn + m), where n is number of unique nodes in tree and m is number
+    // of duplicate priorities
+    //
+    void insertNode(T value, int priority, int ticket) {
+        // Create a new node with the given value and priority
+        NODE* newNode = new NODE;
+        newNode->priority = priority;
+        newNode->value = move(value);
+        newNode->dup = false;
+        newNode->ticket = ticket;
+        newNode->parent = nullptr;
+        newNode->link = nullptr;
+        newNode->left = nullptr;
+        newNode->right = nullptr;
+        pool[ticket].value = T();
+        pool[ticket].level = ENTRY_TREE;
+        pool[ticket].node = newNode;
+
+        // If the tree is empty, set newNode as root
+        if (root == nullptr) {
+            root = newNode;
+            size++;
+            return;
+        }
+
+        NODE* currNode = root;
+        NODE* prevNode = nullptr;
+
+        // Traverse the tree to find the correct location for newNode
+        while (currNode != nullptr) {
+            if (priority == currNode->priority) {
+                // If the priority already exists in the tree, add newNode to its linked list
+                newNode->dup = true;
+                while (currNode->link != nullptr) {
+                    currNode = currNode->link;
                 }
-                thisPtr = thisPtr->parent;
-                otherPtr = otherPtr->parent;
+                currNode->link = newNode;
+
+                size++;
+                return;
+            }
+            prevNode = currNode;
+            if (priority < currNode->priority) {
+                currNode = currNode->left;
+            } else {
+                currNode = currNode->right;
             }
         }
 
-        // If we have reached the end of one priority queue but not the other,
-        // the priority queues are not equal
-        if (thisPtr != nullptr || otherPtr != nullptr) {
-            return false;
+        // Attach newNode to the correct leaf node
+        newNode->parent = prevNode;
+        if (priority < prevNode->priority) {
+            prevNode->left = newNode;
+        } else {
+            prevNode->right = newNode;
         }
+        size++;
+    }
 
-        // If we have not found any differences between the two priority queues,
-        // they are equal
-        return true;
+    void removeNode(NODE* node) {
+        if (node->dup) {
+            // A duplicate only hangs off the linked list of its tree node
+            NODE* prevNode = findNode(root, node->priority);
+            while (prevNode->link != node) {
+                prevNode = prevNode->link;
+            }
+            prevNode->link = node->link;
+        } else if (node->link != nullptr) {
+            // If there are duplicates, the next one takes over the node's
+            // place in the tree
+            NODE* linkNode = node->link;
+            linkNode->dup = false;
+            linkNode->left = node->left;
+            linkNode->right = node->right;
+            if (linkNode->left != nullptr) {
+                linkNode->left->parent = linkNode;
+            }
+            if (linkNode->right != nullptr) {
+                linkNode->right->parent = linkNode;
+            }
+            replaceNode(node, linkNode);
+        } else if (node->left == nullptr || node->right == nullptr) {
+            // If the node has at most one child, replace it with that child
+            NODE* childNode = (node->left == nullptr ? node->right : node->left);
+            replaceNode(node, childNode);
+        } else {
+            // If the node has two children, replace it with its predecessor,
+            // which brings its own duplicates along
+            NODE* predNode = node->left;
+            while (predNode->right != nullptr) {
+                predNode = predNode->right;
+            }
+            replaceNode(predNode, predNode->left);
+            predNode->left = node->left;
+            predNode->right = node->right;
+            if (predNode->left != nullptr) {
+                predNode->left->parent = predNode;
+            }
+            predNode->right->parent = predNode;
+            replaceNode(node, predNode);
+        }
+        delete node;
     }
 
-    NODE* leftmostNode(NODE* node) const {
-        while (node->left != nullptr) {
-            node = node->left;
+    // Puts newNode (which may be null) where node hangs in the tree.
+    void replaceNode(NODE* node, NODE* newNode) {
+        if (newNode != nullptr) {
+            newNode->parent = node->parent;
+        }
+        if (node->parent == nullptr) {
+            root = newNode;
+        } else if (node->parent->left == node) {
+            node->parent->left = newNode;
+        } else {
+            node->parent->right = newNode;
         }
-        return node;
     }
-    
+
+    // Returns the element after "node" in the BST, walking duplicates first.
+    NODE* successorNode(NODE* node) const {
+        if (node->link != nullptr) {
+            return node->link;
+        }
+        if (node->dup) {
+            node = findNode(root, node->priority);
+        }
+        if (node->right != nullptr) {
+            // If node has a right subtree, go to the leftmost node in the right subtree
+            return leftmostNode(node->right);
+        }
+        // Otherwise, go up the tree until we find a node that is a left child
+        NODE* parentNode = node->parent;
+        while (parentNode != nullptr && node == parentNode->right) {
+            node = parentNode;
+            parentNode = parentNode->parent;
+        }
+        return parentNode;
+    }
+
+    // Merges the BST (from "node") and the wheel entries in "order" (from
+    // "pos"): returns the smaller of the two and advances past it.  On equal
+    // priorities the BST goes first, as it does for dequeue.
+    bool nextElement(NODE*& node, const vector<int>& order, int& pos, T& value, int& priority) const {
+        bool wheelLeft = pos < (int)order.size();
+        if (node != nullptr && (!wheelLeft || node->priority <= pool[order[pos]].priority)) {
+            value = node->value;
+            priority = node->priority;
+            node = successorNode(node);
+            return true;
+        }
+        if (wheelLeft) {
+            value = pool[order[pos]].value;
+            priority = pool[order[pos]].priority;
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
     //
-    // getRoot - Do not edit/change!
+    // settle:
     //
-    // Used for testing the BST.
-    // return the root node for testing.
+    // Makes sure the BST holds the element that dequeue and peek must return.
+    // If the smallest wheel priority is below everything in the BST, its slot
+    // is cascaded into the BST.  On equal priorities the BST goes first, since
+    // those elements were enqueued earlier.
+    // Scans at most WHEEL_LEVELS * WHEEL_SLOTS slots, plus O(1) per entry
+    // moved down a level and O(logn + m) per entry moved into the BST
     //
-    void* getRoot() {
-        return root;
+    void settle() {
+        if (wheelSize == 0) {
+            return;
+        }
+        if (root != nullptr && leftmostNode(root)->priority < base) {
+            return;
+        }
+        int priority = wheelMin();
+        if (root == nullptr || leftmostNode(root)->priority > priority) {
+            cascadeToTree(0, wheelKey(priority) & (WHEEL_SLOTS - 1));
+        }
+    }
+
+    // Maps a priority to an unsigned key with the same order, so the wheel
+    // can shift and mask negative priorities too.
+    static unsigned int wheelKey(int priority) {
+        return (unsigned int)priority ^ 0x80000000u;
+    }
+
+    static int keyPriority(unsigned int key) {
+        return (int)(key ^ 0x80000000u);
+    }
+
+    // Returns the wheel level for the priority, or -1 if it belongs in the BST.
+    int wheelLevel(int priority) const {
+        if (priority < base) {
+            return -1;
+        }
+        unsigned int p = wheelKey(priority);
+        unsigned int b = wheelKey(base);
+        for (int k = 0; k < WHEEL_LEVELS - 1; k++) {
+            int shift = WHEEL_BITS * (k + 1);
+            if ((p >> shift) == (b >> shift)) {
+                return k;
+            }
+        }
+        int shift = WHEEL_BITS * (WHEEL_LEVELS - 1);
+        if ((p >> shift) - (b >> shift) < (unsigned int)WHEEL_SLOTS) {
+            return WHEEL_LEVELS - 1;
+        }
+        return -1;
+    }
+
+    // Returns the slot of the level that is "distance" slots past base's.
+    // Levels below the top never wrap, so there distance stops at the last
+    // slot; the top level wraps around.
+    int wheelSlot(int level, int distance) const {
+        int current = (wheelKey(base) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+        return (current + distance) & (WHEEL_SLOTS - 1);
+    }
+
+    // Returns how many slots of the level lie in priority order from base's,
+    // which is where wheelSlot distances run from.  Only level 0 can have
+    // entries in base's own slot.
+    int wheelSlots(int level) const {
+        if (level == WHEEL_LEVELS - 1) {
+            return WHEEL_SLOTS;
+        }
+        int current = (wheelKey(base) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+        return WHEEL_SLOTS - current;
+    }
+
+    // Puts the entry in its wheel slot, or in the BST if it is out of range.
+    void placeEntry(int index) {
+        WHEELNODE& entry = pool[index];
+        int level = wheelLevel(entry.priority);
+        if (level < 0) {
+            insertNode(move(entry.value), entry.priority, index);
+            return;
+        }
+        entry.level = level;
+        entry.slot = (wheelKey(entry.priority) >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+        entry.prev = tails[entry.level][entry.slot];
+        entry.next = -1;
+        if (entry.prev != -1) {
+            pool[entry.prev].next = index;
+        } else {
+            heads[entry.level][entry.slot] = index;
+        }
+        tails[entry.level][entry.slot] = index;
+        wheelSize++;
+    }
+
+    // Detaches the entry from its slot.
+    void unlinkEntry(int index) {
+        WHEELNODE& entry = pool[index];
+        if (entry.prev != -1) {
+            pool[entry.prev].next = entry.next;
+        } else {
+            heads[entry.level][entry.slot] = entry.next;
+        }
+        if (entry.next != -1) {
+            pool[entry.next].prev = entry.prev;
+        } else {
+            tails[entry.level][entry.slot] = entry.prev;
+        }
+    }
+
+    // Returns the entry to the free list and invalidates its ticket.
+    void freeEntry(int index) {
+        pool[index].gen++;
+        pool[index].value = T();
+        pool[index].level = ENTRY_FREE;
+        pool[index].node = nullptr;
+        pool[index].next = freeHead;
+        freeHead = index;
+    }
+
+    // Detaches every entry of the slot and places it again, keeping order.
+    void replaceSlot(int level, int slot) {
+        int index = heads[level][slot];
+        heads[level][slot] = -1;
+        tails[level][slot] = -1;
+        while (index != -1) {
+            int nextIndex = pool[index].next;
+            wheelSize--;
+            placeEntry(index);
+            index = nextIndex;
+        }
+    }
+
+    // Returns the smallest priority in the wheel, cascading higher level
+    // slots down as base enters them.  The wheel must not be empty.
+    int wheelMin() {
+        int k = 0;
+        while (k < WHEEL_LEVELS) {
+            int d = (k == 0 ? 0 : 1);
+            while (d < wheelSlots(k) && heads[k][wheelSlot(k, d)] == -1) {
+                d++;
+            }
+            if (d == wheelSlots(k)) {
+                k++;
+                continue;
+            }
+            if (k == 0) {
+                return base + d;
+            }
+
+            // Start base at the slot's first priority and spread the slot
+            // over the lower levels, keeping its order
+            int shift = WHEEL_BITS * k;
+            unsigned int block = (wheelKey(base) >> shift) + d;
+            int slot = wheelSlot(k, d);
+            base = keyPriority(block << shift);
+            replaceSlot(k, slot);
+            k = 0;
+        }
+        return base;
+    }
+
+    // Appends the wheel entries to "order", lowest priority first and in
+    // enqueue order within a priority.
+    void wheelOrder(vector<int>& order) const {
+        for (int k = 0; k < WHEEL_LEVELS; k++) {
+            for (int d = (k == 0 ? 0 : 1); d < wheelSlots(k); d++) {
+                int first = (int)order.size();
+                for (int index = heads[k][wheelSlot(k, d)]; index != -1; index = pool[index].next) {
+                    order.push_back(index);
+                }
+                if (k > 0) {
+                    // Slots above level 0 span several priorities
+                    stable_sort(order.begin() + first, order.end(), [this](int a, int b) {
+                        return pool[a].priority < pool[b].priority;
+                    });
+                }
+            }
+        }
+    }
+
+    // Moves every entry of the slot into the BST, keeping their order.
+    void cascadeToTree(int level, int slot) {
+        int index = heads[level][slot];
+        heads[level][slot] = -1;
+        tails[level][slot] = -1;
+        while (index != -1) {
+            int nextIndex = pool[index].next;
+            insertNode(move(pool[index].value), pool[index].priority, index);
+            wheelSize--;
+            index = nextIndex;
+        }
     }
 };
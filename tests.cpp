@@ -21,8 +21,23 @@ TEST_CASE("Find node returns correct node") {
     q.enqueue(4, 5);
     q.enqueue(6, 15);
     q.enqueue(8, 5);
-    auto node = q.findNode(6);
+    auto node = q.findNode(10);
     REQUIRE(node->value == 2);
+    REQUIRE(q.findNode(6) == nullptr);
+}
+
+TEST_CASE("Find node keeps tickets and order of wheel elements") {
+    priorityqueue<int> q;
+    q.enqueue(1, 0);
+    auto ticket = q.enqueue(2, 5000);
+    q.enqueue(3, 5000);
+    q.enqueue(4, 5001);
+    REQUIRE(q.findNode(5000)->value == 2);
+    REQUIRE(q.cancel(ticket));
+    REQUIRE(q.findNode(5000)->value == 3);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.dequeue() == 3);
+    REQUIRE(q.dequeue() == 4);
 }
 
 TEST_CASE("Clear empties the queue") {
@@ -42,9 +57,9 @@ TEST_CASE("Enqueue adds elements to the queue") {
 
 TEST_CASE("Dequeue removes and returns the highest priority element") {
     priorityqueue<int> q;
-    q.enqueue(2, 10);
-    q.enqueue(4, 5);
-    q.enqueue(6, 15);
+    q.enqueue(10, 2);
+    q.enqueue(5, 4);
+    q.enqueue(15, 6);
     auto value = q.dequeue();
     REQUIRE(value == 10);
 }
@@ -60,14 +75,16 @@ TEST_CASE("Begin returns an iterator to the first element in the queue") {
     priorityqueue<int> q;
     q.enqueue(2, 10);
     q.enqueue(4, 5);
-    auto it = q.begin();
-    REQUIRE(it->value == 5);
+    q.begin();
+    int value, priority;
+    REQUIRE(q.next(value, priority));
+    REQUIRE(priority == 5);
 }
 
 TEST_CASE("Tostring returns a string representation of the queue") {
     priorityqueue<int> q;
-    q.enqueue(2, 10);
-    REQUIRE(q.tostring() == "2 value: 10");
+    q.enqueue(10, 2);
+    REQUIRE(q.toString() == "2 value: 10\n");
 }
 
 TEST_CASE("Operator== returns true if two queues are equal") {
@@ -80,6 +97,155 @@ TEST_CASE("Operator== returns true if two queues are equal") {
     REQUIRE(q1 == q2);
 }
 
+TEST_CASE("Near and far priorities dequeue in priority order") {
+    priorityqueue<int> q;
+    q.enqueue(1, 100);
+    q.enqueue(2, 100000000);
+    q.enqueue(3, 50);
+    q.enqueue(4, 5000);
+    q.enqueue(5, 100);
+    REQUIRE(q.dequeue() == 3);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.dequeue() == 5);
+    REQUIRE(q.dequeue() == 4);
+    REQUIRE(q.dequeue() == 2);
+}
+
+TEST_CASE("Cancel removes a pending element") {
+    priorityqueue<int> q;
+    q.enqueue(1, 10);
+    auto ticket = q.enqueue(2, 20);
+    q.enqueue(3, 30);
+    REQUIRE(q.cancel(ticket));
+    REQUIRE_FALSE(q.cancel(ticket));
+    REQUIRE(q.Size() == 2);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.dequeue() == 3);
+}
+
+TEST_CASE("Cancel works after the element moved into the BST") {
+    priorityqueue<int> q;
+    auto near = q.enqueue(1, 10);
+    q.enqueue(2, 20);
+    REQUIRE(q.peek() == 1);  // moves priority 10 into the BST
+    REQUIRE(q.cancel(near));
+    REQUIRE(q.peek() == 2);
+    auto far = q.enqueue(3, 1 << 30);
+    REQUIRE(q.cancel(far));
+    REQUIRE(q.Size() == 1);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE_FALSE(q.cancel(near));
+}
+
+TEST_CASE("Cancel only fails once the element has left the queue") {
+    priorityqueue<int> q;
+    auto first = q.enqueue(1, 16777210);
+    auto second = q.enqueue(2, 16777220);  // just past a 2^24 boundary
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE_FALSE(q.cancel(first));
+    REQUIRE(q.cancel(second));
+    REQUIRE(q.Size() == 0);
+}
+
+TEST_CASE("Equal priorities in the wheel and the BST keep enqueue order") {
+    priorityqueue<int> q;
+    int far = 100 + (1 << 25);
+    q.enqueue(1, 100);
+    q.enqueue(2, far);  // too far out for the wheel, goes to the BST
+    REQUIRE(q.dequeue() == 1);
+    q.enqueue(3, far);  // the empty wheel re-anchors here
+    q.enqueue(4, far);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE(q.dequeue() == 3);
+    REQUIRE(q.dequeue() == 4);
+}
+
+TEST_CASE("Cascades from the upper wheel levels keep order") {
+    priorityqueue<int> q;
+    q.enqueue(1, 0);
+    q.enqueue(2, 300000);  // level 3
+    q.enqueue(3, 5000);  // level 2
+    q.enqueue(4, 300000);
+    q.enqueue(5, 70);  // level 1
+    q.enqueue(6, 5000);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.dequeue() == 5);
+    REQUIRE(q.dequeue() == 3);
+    REQUIRE(q.dequeue() == 6);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE(q.dequeue() == 4);
+}
+
+TEST_CASE("Priorities below the wheel go to the BST") {
+    priorityqueue<int> q;
+    q.enqueue(1, 5000);
+    q.enqueue(2, 70);
+    auto low = q.enqueue(3, -20);
+    REQUIRE(q.cancel(low));
+    q.enqueue(4, -20);
+    REQUIRE(q.dequeue() == 4);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE(q.dequeue() == 1);
+}
+
+TEST_CASE("Read-only calls and copies keep wheel entries") {
+    priorityqueue<int> q;
+    auto ticket = q.enqueue(1, 10);
+    q.enqueue(2, 5000);
+    REQUIRE(q.toString() == "10 value: 1\n5000 value: 2\n");
+    const priorityqueue<int> constCopy(q);
+    priorityqueue<int> copy;
+    copy = q;
+    REQUIRE(copy == q);
+    REQUIRE(constCopy == q);
+    REQUIRE(q.cancel(ticket));
+    REQUIRE_FALSE(copy == q);
+    REQUIRE(copy.Size() == 2);
+    REQUIRE(copy.dequeue() == 1);
+}
+
+TEST_CASE("Begin and next walk the wheel and the BST in order") {
+    priorityqueue<int> q;
+    q.enqueue(1, 10);
+    q.enqueue(2, 1 << 30);  // BST
+    q.enqueue(3, 5000);
+    q.enqueue(4, 10);
+    int value, priority;
+    q.begin();
+    REQUIRE(q.next(value, priority));
+    REQUIRE(value == 1);
+    REQUIRE(q.next(value, priority));
+    REQUIRE(value == 4);
+    REQUIRE(q.next(value, priority));
+    REQUIRE(value == 3);
+    REQUIRE(q.next(value, priority));
+    REQUIRE(value == 2);
+    REQUIRE_FALSE(q.next(value, priority));
+}
+
+TEST_CASE("Dequeue of the last element empties the queue") {
+    priorityqueue<int> q;
+    q.enqueue(1, 5);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.Size() == 0);
+    q.enqueue(2, 7);
+    REQUIRE(q.peek() == 2);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE_THROWS(q.dequeue());
+}
+
+TEST_CASE("Dequeue of a duplicate keeps the right subtree") {
+    priorityqueue<int> q;
+    q.enqueue(10, 0);  // anchors the wheel; the rest go to the BST
+    q.enqueue(1, 1 << 28);
+    q.enqueue(2, 1 << 28);
+    q.enqueue(3, 1 << 29);
+    REQUIRE(q.dequeue() == 10);
+    REQUIRE(q.dequeue() == 1);
+    REQUIRE(q.dequeue() == 2);
+    REQUIRE(q.dequeue() == 3);
+}
+
 TEST_CASE("Operator== returns false if two queues are not equal") {
     priorityqueue<int> q1;
     q1.enqueue(2, 10);
@@ -88,13 +254,14 @@ TEST_CASE("Operator== returns false if two queues are not equal") {
     q2.enqueue(2, 10);
     q2.enqueue(6, 5);
     REQUIRE_FALSE(q1 == q2);
-    
+}
+
 TEST_CASE("Peek does not remove elements from the queue") {
-    PriorityQueue<int> pq;
-    pq.push(2, 10);
-    pq.push(1, 20);
-    pq.push(3, 5);
-    REQUIRE(pq.size() == 3);
+    priorityqueue<int> pq;
+    pq.enqueue(2, 10);
+    pq.enqueue(1, 20);
+    pq.enqueue(3, 5);
+    REQUIRE(pq.Size() == 3);
     pq.peek();
-    REQUIRE(pq.size() == 3);
+    REQUIRE(pq.Size() == 3);
 }